@@ -0,0 +1,2 @@
+g++ -std=c++20 -O2 ./lollipop/lollipop.h ./src/benchmark.cpp -o ./build/benchmark.out
+./build/benchmark.out
@@ -13,10 +13,10 @@
 #include <string>
 #include <array>
 #include <unordered_map>
+#include <vector>
 #include <utility>
 #include <type_traits>
-#define FMT_HEADER_ONLY
-#include <fmt/core.h> // sudo apt install libfmt-dev
+#include <algorithm>
 
 namespace Lollipop {
     // Utility Functions
@@ -103,30 +103,200 @@ namespace Lollipop {
         Error // When the program crashes due to error
     };
 
+    // Why an Error end happened, recorded on the Executor instead of being thrown
+    const size_t NUM_FAULTS = 3;
+    enum Fault {
+        None, // When there's no fault
+        OutOfBounds, // When memory is accessed outside of its size
+        DivideByZero // When DIV or MOD is given a divisor of 0
+    };
+
+    inline const std::array<std::string, NUM_FAULTS> faultStr = {
+        "None",
+        "OutOfBounds",
+        "DivideByZero"
+    };
+
+    // Chains shallower than this are cheaper to walk than to look up
+    const size_t MIN_CACHED_INDIRECTION_DEPTH = 8;
+
     // Class Declarations
 
+    // How well the cache of resolved GOTO indirection chains is doing
+    struct IndirectionStats {
+        uint64_t hits = 0; // Chains resolved in one step from the cache
+        uint64_t misses = 0; // Chains that had to be walked
+        uint64_t invalidations = 0; // Cached chains dropped because a word they went through was written to
+    };
+
     template <typename NBit>
     class Memory {
     public:
         NBit* array;
         NBit size;
-
-        Memory(NBit* array, NBit size) {
+        // The first fault since the last clear_fault() and the address that caused it
+        Fault fault;
+        NBit faultAddress;
+        // Out of bounds accesses through operator[] read and write this instead of throwing
+        NBit sink;
+        // Whether deref() remembers the chains it walks
+        bool cacheIndirections;
+        IndirectionStats indirectionStats;
+
+        Memory(NBit* array, NBit size, bool cacheIndirections = true) {
             static_assert(std::is_unsigned_v<NBit> == true);
 
             this->array = array;
             this->size = size;
+            this->fault = Fault::None;
+            this->faultAddress = 0;
+            this->sink = 0;
+            this->cacheIndirections = cacheIndirections;
         }
 
-        // For safely accessing memory
+        // Copies share array but start without cached chains, since writes through one copy can't invalidate the other's
+        Memory(const Memory& other) {
+            static_assert(std::is_unsigned_v<NBit> == true);
+
+            this->copy_without_indirections(other);
+        }
+
+        Memory& operator=(const Memory& other) {
+            if (this != &other)
+                this->copy_without_indirections(other);
+            return *this;
+        }
+
+        // For safely accessing memory that may be written to, instructions use read() and write() instead
+        // Writes that bypass this (e.g. through array directly or another copy of this Memory) have to call invalidate_indirections() themselves
         NBit& operator[](NBit i) {
             // For uint hopefully the latter gets optimized out depending on compiler
             // , but if it doesn't the performance cost shouldn't be too large
-            if (i >= size || i < 0)
-                throw std::invalid_argument(fmt::format("Index {} is out of bounds: 0 to {} (inclusive to exclusive).", i, this->size));
+            if (i >= size || i < 0) [[unlikely]] {
+                this->raise(Fault::OutOfBounds, i);
+                this->sink = 0;
+                return this->sink;
+            }
+            if (!this->watched.empty() && this->watched[i]) [[unlikely]]
+                this->invalidate_watchers(i);
             return array[i];
         }
 
+        // For safely reading memory without counting as a write
+        NBit read(NBit i) {
+            if (i >= size || i < 0) [[unlikely]] {
+                this->raise(Fault::OutOfBounds, i);
+                return 0;
+            }
+            return array[i];
+        }
+
+        // For safely writing memory, which is skipped if the instruction has already faulted so it can't leave a partial result
+        void write(NBit i, NBit value) {
+            if (this->fault != Fault::None) [[unlikely]]
+                return;
+            if (i >= size || i < 0) [[unlikely]] {
+                this->raise(Fault::OutOfBounds, i);
+                return;
+            }
+            if (!this->watched.empty() && this->watched[i]) [[unlikely]]
+                this->invalidate_watchers(i);
+            array[i] = value;
+        }
+
+        // Follow depth references starting from address, returning the address itself for a depth of 0
+        // Deep enough chains are cached until one of the words they went through is written to, which only drops the chains using that word
+        NBit deref(NBit address, NBit depth) {
+            if (depth < MIN_CACHED_INDIRECTION_DEPTH || !this->cacheIndirections) {
+                for (NBit i = 0; i < depth; i++)
+                    address = this->read(address);
+                return address;
+            }
+
+            const std::pair<NBit, NBit> key = { address, depth };
+            const auto cached = this->indirections.find(key);
+            if (cached != this->indirections.end()) {
+                this->indirectionStats.hits++;
+                return cached->second.result;
+            }
+            this->indirectionStats.misses++;
+
+            if (this->watched.empty()) {
+                this->watched.resize(this->size, false);
+                this->visiting.resize(this->size, false);
+            }
+
+            // Walk the chain once, remembering the distinct words it goes through
+            // Coming back to one of them means the rest of the chain loops, so the result can be picked out of the loop
+            std::vector<NBit> addresses = std::vector<NBit>();
+            addresses.reserve(std::min(depth, this->size));
+            NBit result = address;
+            for (NBit i = 0; i < depth; i++) {
+                if (result < this->size && this->visiting[result]) {
+                    const NBit loopStart = std::find(addresses.begin(), addresses.end(), result) - addresses.begin();
+                    const NBit loopLength = addresses.size() - loopStart;
+                    result = addresses[loopStart + (depth - loopStart) % loopLength];
+                    break;
+                }
+
+                const NBit next = this->read(result);
+                if (this->fault != Fault::None)
+                    break;
+                this->visiting[result] = true;
+                addresses.push_back(result);
+                result = next;
+            }
+            for (NBit visited : addresses)
+                this->visiting[visited] = false;
+
+            // Only watch chains that are known not to fault
+            if (this->fault != Fault::None)
+                return result;
+            for (NBit watchedAddress : addresses) {
+                this->watched[watchedAddress] = true;
+                this->watchers[watchedAddress].push_back(key);
+            }
+            this->indirections.emplace(key, CachedIndirection{ result, std::move(addresses) });
+
+            return result;
+        }
+
+        // Forget the chains that went through address
+        void invalidate_watchers(NBit address) {
+            const auto watching = this->watchers.find(address);
+            if (watching == this->watchers.end())
+                return;
+
+            const std::vector<std::pair<NBit, NBit>> keys = std::move(watching->second);
+            this->watchers.erase(watching);
+            this->watched[address] = false;
+            for (const std::pair<NBit, NBit>& key : keys)
+                this->forget_indirection(key);
+        }
+
+        // Forget every cached chain and stop watching their words
+        void invalidate_indirections() {
+            this->indirectionStats.invalidations += this->indirections.size();
+
+            for (const auto& [address, keys] : this->watchers)
+                this->watched[address] = false;
+            this->watchers.clear();
+            this->indirections.clear();
+        }
+
+        // Record a fault, keeping the first one if several happen in the same instruction
+        void raise(Fault fault, NBit address) {
+            if (this->fault != Fault::None)
+                return;
+            this->fault = fault;
+            this->faultAddress = address;
+        }
+
+        void clear_fault() {
+            this->fault = Fault::None;
+            this->faultAddress = 0;
+        }
+
         // Clone the memory
         NBit* clone() {
             NBit* new_array = new NBit[this->size];
@@ -134,15 +304,73 @@ namespace Lollipop {
 
             return Memory(new_array, this->size);
         }
+
+    private:
+        struct PairHash {
+            size_t operator()(const std::pair<NBit, NBit>& pair) const {
+                return std::hash<NBit>()(pair.first) ^ (std::hash<NBit>()(pair.second) * 0x9E3779B97F4A7C15ull);
+            }
+        };
+
+        struct CachedIndirection {
+            NBit result;
+            // The words the chain went through, without duplicates
+            std::vector<NBit> addresses;
+        };
+
+        // (address, depth) to the address the chain resolves to
+        std::unordered_map<std::pair<NBit, NBit>, CachedIndirection, PairHash> indirections;
+        // Words that a cached chain went through to the (address, depth) of those chains
+        std::unordered_map<NBit, std::vector<std::pair<NBit, NBit>>> watchers;
+        // Whether a word is in watchers, so that writes to unwatched words skip the lookup
+        std::vector<bool> watched;
+        // Words deref() has gone through in the chain it's currently walking
+        std::vector<bool> visiting;
+
+        // Take everything but the cached chains from other
+        void copy_without_indirections(const Memory& other) {
+            this->array = other.array;
+            this->size = other.size;
+            this->fault = other.fault;
+            this->faultAddress = other.faultAddress;
+            this->sink = other.sink;
+            this->cacheIndirections = other.cacheIndirections;
+            this->indirectionStats = IndirectionStats();
+            this->indirections.clear();
+            this->watchers.clear();
+            this->watched.clear();
+            this->visiting.clear();
+        }
+
+        // Drop a cached chain and its watches
+        void forget_indirection(const std::pair<NBit, NBit>& key) {
+            const auto cached = this->indirections.find(key);
+            if (cached == this->indirections.end())
+                return;
+            this->indirectionStats.invalidations++;
+
+            for (NBit address : cached->second.addresses) {
+                const auto watching = this->watchers.find(address);
+                if (watching == this->watchers.end())
+                    continue;
+
+                std::erase(watching->second, key);
+                if (watching->second.empty()) {
+                    this->watchers.erase(watching);
+                    this->watched[address] = false;
+                }
+            }
+            this->indirections.erase(cached);
+        }
    };
 
     template <typename NBit>
     struct InstructionData {
         std::string str;
         size_t numParams;
-        void (*op)(Memory<NBit>, std::array<NBit, MAX_NUM_PARAMS>, NBit&, EndReason&);
+        void (*op)(Memory<NBit>&, std::array<NBit, MAX_NUM_PARAMS>, NBit&, EndReason&);
 
-        InstructionData(std::string str, size_t numParams, void (*op)(Memory<NBit>, std::array<NBit, MAX_NUM_PARAMS>, NBit&, EndReason&)) {
+        InstructionData(std::string str, size_t numParams, void (*op)(Memory<NBit>&, std::array<NBit, MAX_NUM_PARAMS>, NBit&, EndReason&)) {
             static_assert(std::is_unsigned_v<NBit> == true);
 
             this->str = str;
@@ -151,37 +379,49 @@ namespace Lollipop {
         }
     };
 
-    #define OP(instruction) [](Memory<uint64_t> mem, std::array<uint64_t, MAX_NUM_PARAMS> args, uint64_t& line, EndReason& endReason){ instruction; }
+    #define OP(instruction) [](Memory<uint64_t>& mem, std::array<uint64_t, MAX_NUM_PARAMS> args, uint64_t& line, EndReason& endReason){ instruction; }
     #define INS(str, numParams, op) InstructionData<uint64_t>(str, numParams, OP(op))
     #define arg0 args[0]
     #define arg1 args[1]
-    #define marg0 mem[arg0]
-    #define marg1 mem[arg1]
+    #define marg0 mem.read(arg0)
+    #define marg1 mem.read(arg1)
+    // Operands are read before this so that a faulting read stops the write
+    #define set0(value) mem.write(arg0, value)
 
     // InstructionType to InstructionData
     inline const std::array<InstructionData<uint64_t>, NUM_INSTRUCTIONS> instructionData = {
-        INS("AND", 2, marg0 &= marg1),
-        INS("OR", 2, marg0 |= marg1),
-        INS("XOR", 2, marg0 ^= marg1),
-        INS("NOT", 2, marg0 = ~marg0),
+        INS("AND", 2, set0(marg0 & marg1)),
+        INS("OR", 2, set0(marg0 | marg1)),
+        INS("XOR", 2, set0(marg0 ^ marg1)),
+        INS("NOT", 2, set0(~marg0)),
         INS("SHIFT", 2, {
-            marg0 = marg1 > 0 ?
+            set0(marg1 > 0 ?
                 marg0 >> marg1 :
-                marg0 << -marg1;
+                marg0 << -marg1);
         }),
-        INS("ADD", 2, marg0 += marg1),
-        INS("SUB", 2, marg0 -= marg1),
-        INS("MUL", 2, marg0 *= marg1),
-        INS("DIV", 2, marg0 /= marg1),
-        INS("MOD", 2, marg0 %= marg1),
-        INS("LESS", 2, marg0 = marg0 < marg1),
-        INS("EQU", 2, marg0 = marg0 == marg1),
-        INS("COPY", 2, marg1 = marg0),
+        INS("ADD", 2, set0(marg0 + marg1)),
+        INS("SUB", 2, set0(marg0 - marg1)),
+        INS("MUL", 2, set0(marg0 * marg1)),
+        INS("DIV", 2, {
+            const uint64_t divisor = marg1;
+            if (divisor == 0)
+                mem.raise(Fault::DivideByZero, arg1);
+            else
+                set0(marg0 / divisor);
+        }),
+        INS("MOD", 2, {
+            const uint64_t divisor = marg1;
+            if (divisor == 0)
+                mem.raise(Fault::DivideByZero, arg1);
+            else
+                set0(marg0 % divisor);
+        }),
+        INS("LESS", 2, set0(marg0 < marg1)),
+        INS("EQU", 2, set0(marg0 == marg1)),
+        INS("COPY", 2, mem.write(arg1, marg0)),
         INS("GOTO", 2, {
-            line = arg1;
             // Depending on the first argument jump between references
-            for (uint64_t i = 0; i < arg0; i++)
-                line = mem[line];
+            line = mem.deref(arg1, arg0);
 
             // End if it's 0
             if (line == 0)
@@ -192,16 +432,17 @@ namespace Lollipop {
         }),
         INS("INPUT", 1, {
             endReason = EndReason::Input;
-            marg0 = input_uint64_t();
+            set0(input_uint64_t());
             endReason = EndReason::Null;
         }),
-        INS("LOAD", 2, marg0 = mem[marg1])
+        INS("LOAD", 2, set0(mem.read(marg1)))
     };
 
     #undef INS
     #undef OP
     #undef marg0
     #undef marg1
+    #undef set0
 
     #define SIP(ins) { instructionData[ins].str, ins }
 
@@ -266,19 +507,29 @@ namespace Lollipop {
         // The bytecode
         Instruction<NBit>* byteCode;
         NBit byteCodeSize;
-        // The memory
+        // The memory, a copy of the one given to the constructor that shares its array
+        // Writing to the array through anything but this copy has to be followed by memory.invalidate_indirections() so GOTO doesn't use stale chains
         Memory<NBit> memory;
         // The current line
         NBit line;
         // EndReason
         EndReason endReason;
-
+        // The fault behind an EndReason::Error, the address that caused it, and the line it happened on
+        Fault fault;
+        NBit faultAddress;
+        NBit faultLine;
+        // Called when a fault happens with line already past the faulting instruction, which never writes a partial result
+        // Setting endReason back to EndReason::Null skips that instruction and continues, changing line jumps elsewhere instead
+        void (*faultHandler)(Executor<NBit>*);
+
+        // memory is copied without its cached chains, so keep writing through executor.memory afterwards rather than the original
         Executor(
             Instruction<NBit>* byteCode,
             NBit byteCodeSize,
             Memory<NBit> memory,
             NBit line = 0,
-            EndReason endReason = EndReason::Null
+            EndReason endReason = EndReason::Null,
+            void (*faultHandler)(Executor<NBit>*) = nullptr
         ) : memory(memory)
         {
             static_assert(std::is_unsigned_v<NBit> == true);
@@ -287,9 +538,13 @@ namespace Lollipop {
             this->byteCodeSize = byteCodeSize;
             this->line = line;
             this->endReason = endReason;
+            this->fault = Fault::None;
+            this->faultAddress = 0;
+            this->faultLine = 0;
+            this->faultHandler = faultHandler;
         }
 
-        // This will run until the program ends, an exception happens, or an input statement is reached
+        // This will run until the program ends, a fault happens, or an input statement is reached
         EndReason run(void (*callback)(Executor<NBit>*) = nullptr) {
             while (this->endReason == EndReason::Null) {
                 this->run_tick();
@@ -311,25 +566,35 @@ namespace Lollipop {
             const Instruction<NBit>& instruction = byteCode[line];
             const Lollipop::InstructionData<NBit>& instructionData = Lollipop::instructionData[instruction.type];
 
-            // Execute the instruction and increment
-            try {
-                instructionData.op(this->memory, instruction.params, this->line, this->endReason);
-                this->line++;
-            }
-            catch (std::exception& e) { // Don't throw any errors of a type that doesn't inherit from std::exception
-                this->endReason = EndReason::Error;
-                std::cout << e.what() << std::endl;
-            }
-            catch (...) {
+            // Execute the instruction and increment, dropping any fault left over from the host accessing memory between ticks
+            const NBit executedLine = this->line;
+            this->memory.clear_fault();
+            instructionData.op(this->memory, instruction.params, this->line, this->endReason);
+            if (this->memory.fault != Fault::None) [[unlikely]] {
+                // Move past the faulting line so that resuming from a fault handler skips it
+                this->fault = this->memory.fault;
+                this->faultAddress = this->memory.faultAddress;
+                this->faultLine = executedLine;
+                this->line = executedLine + 1;
                 this->endReason = EndReason::Error;
-                std::cout <<
-                    "An exception of a type not inheriting from std::exception was thrown!" << 
-                    "Please change the thrown exception to inherit from std::exception!" << std::endl;
+                this->memory.clear_fault();
+
+                if (this->faultHandler != nullptr)
+                    this->faultHandler(this);
+                return this->endReason;
             }
+            this->line++;
 
             return this->endReason;
         }
 
+        // Clear the recorded fault, e.g. before resuming after one
+        void clear_fault() {
+            this->fault = Fault::None;
+            this->faultAddress = 0;
+            this->faultLine = 0;
+        }
+
         // Check to make sure goto is safe
         bool line_safe() {
             return this->line < byteCodeSize;
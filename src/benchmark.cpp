@@ -0,0 +1,207 @@
+#include <iostream>
+#include <array>
+#include <cstddef>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "../lollipop/lollipop.h"
+
+// Where the table of references that GOTO walks through starts
+const uint64_t TABLE_START = 16;
+const uint64_t NUM_TICKS = 4000000;
+
+struct BenchmarkResult {
+    double nsPerTick;
+    uint64_t counter;
+    Lollipop::IndirectionStats stats;
+};
+
+// Runs a loop of "ADD 2 3" then "GOTO <depth> 16" where the table sends the jump back to line 1 after depth references
+BenchmarkResult run_benchmark(uint64_t depth, bool cacheIndirections) {
+    std::vector<uint64_t> memArr = std::vector<uint64_t>(TABLE_START + depth, 0);
+    memArr[3] = 1;
+    for (uint64_t i = 0; i < depth; i++)
+        memArr[TABLE_START + i] = (i + 1 < depth) ? TABLE_START + i + 1 : 1;
+
+    std::vector<Lollipop::Instruction<uint64_t>> instructions = {
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::ADD, { 2, 3 }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::GOTO, { depth, TABLE_START })
+    };
+
+    Lollipop::Executor executor =
+        Lollipop::Executor<uint64_t>(
+            instructions.data(), instructions.size(),
+            Lollipop::Memory(memArr.data(), memArr.size(), cacheIndirections)
+        );
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < NUM_TICKS && executor.endReason == Lollipop::EndReason::Null; i++)
+        executor.run_tick();
+    const auto end = std::chrono::steady_clock::now();
+
+    return {
+        std::chrono::duration<double, std::nano>(end - start).count() / NUM_TICKS,
+        memArr[2],
+        executor.memory.indirectionStats
+    };
+}
+
+// Runs a loop that jumps through table A, writes to table A, then jumps through table B
+// Only table A's chain should be invalidated, so every jump through table B after the first should hit
+Lollipop::IndirectionStats run_dispatch_benchmark(uint64_t depth) {
+    const uint64_t tableA = TABLE_START;
+    const uint64_t tableB = TABLE_START + depth;
+    std::vector<uint64_t> memArr = std::vector<uint64_t>(TABLE_START + 2 * depth, 0);
+    for (uint64_t i = 0; i < depth; i++) {
+        memArr[tableA + i] = (i + 1 < depth) ? tableA + i + 1 : 2;
+        memArr[tableB + i] = (i + 1 < depth) ? tableB + i + 1 : 1;
+    }
+
+    std::vector<Lollipop::Instruction<uint64_t>> instructions = {
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::GOTO, { depth, tableA }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::COPY, { tableA, tableA }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::GOTO, { depth, tableB })
+    };
+
+    Lollipop::Executor executor =
+        Lollipop::Executor<uint64_t>(
+            instructions.data(), instructions.size(),
+            Lollipop::Memory(memArr.data(), memArr.size())
+        );
+
+    for (uint64_t i = 0; i < NUM_TICKS && executor.endReason == Lollipop::EndReason::Null; i++)
+        executor.run_tick();
+
+    return executor.memory.indirectionStats;
+}
+
+// Runs a loop of "ADD 2 3" then a GOTO far deeper than memory through the references 16 -> 1 -> 16
+// Returns a negative time if the loop didn't resolve to line 1 or a single word referencing itself doesn't end naturally
+double run_loop_benchmark() {
+    const uint64_t depth = 1000000001;
+    std::vector<uint64_t> memArr = std::vector<uint64_t>(TABLE_START + 1, 0);
+    memArr[1] = TABLE_START;
+    memArr[3] = 1;
+    memArr[TABLE_START] = 1;
+
+    std::vector<Lollipop::Instruction<uint64_t>> instructions = {
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::ADD, { 2, 3 }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::GOTO, { depth, TABLE_START })
+    };
+
+    Lollipop::Executor executor =
+        Lollipop::Executor<uint64_t>(
+            instructions.data(), instructions.size(),
+            Lollipop::Memory(memArr.data(), memArr.size())
+        );
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < NUM_TICKS && executor.endReason == Lollipop::EndReason::Null; i++)
+        executor.run_tick();
+    const auto end = std::chrono::steady_clock::now();
+
+    if (executor.endReason != Lollipop::EndReason::Null || memArr[2] != NUM_TICKS / 2)
+        return -1;
+
+    // A word referencing itself resolves to itself, which is past the last line
+    memArr[TABLE_START] = TABLE_START;
+    executor.memory.invalidate_indirections();
+    executor.line = 1;
+    if (executor.run() != Lollipop::EndReason::Natural)
+        return -1;
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / NUM_TICKS;
+}
+
+uint64_t numFaults = 0;
+
+// Runs a loop where every instruction but the counter faults, resuming past each fault from the fault handler
+// Returns a negative time if a faulting instruction changed the memory it would have written to
+double run_fault_benchmark() {
+    std::vector<uint64_t> memArr = std::vector<uint64_t>(8, 0);
+    memArr[3] = 1;
+    memArr[4] = 7;
+    memArr[5] = 9;
+
+    std::vector<Lollipop::Instruction<uint64_t>> instructions = {
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::ADD, { 4, 999 }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::DIV, { 5, 6 }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::COPY, { 999, 4 }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::AND, { 5, 999 }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::ADD, { 2, 3 }),
+        Lollipop::Instruction<uint64_t>(Lollipop::InstructionType::GOTO, { 0, 1 })
+    };
+
+    numFaults = 0;
+    Lollipop::Executor executor =
+        Lollipop::Executor<uint64_t>(
+            instructions.data(), instructions.size(),
+            Lollipop::Memory(memArr.data(), memArr.size()),
+            0, Lollipop::EndReason::Null,
+            [](Lollipop::Executor<uint64_t>* executor) {
+                numFaults++;
+                executor->clear_fault();
+                executor->endReason = Lollipop::EndReason::Null;
+            }
+        );
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < NUM_TICKS && executor.endReason == Lollipop::EndReason::Null; i++)
+        executor.run_tick();
+    const auto end = std::chrono::steady_clock::now();
+
+    if (memArr[4] != 7 || memArr[5] != 9 || memArr[2] != (NUM_TICKS + 1) / 6)
+        return -1;
+    return std::chrono::duration<double, std::nano>(end - start).count() / numFaults;
+}
+
+int main() {
+    const double nsPerFault = run_fault_benchmark();
+    if (nsPerFault < 0) {
+        std::cout << "A faulting instruction wrote to memory!" << std::endl;
+        return 1;
+    }
+    std::cout << "faults\tns/fault" << std::endl;
+    std::cout << numFaults << "\t" << nsPerFault << std::endl << std::endl;
+
+    const double loopNsPerTick = run_loop_benchmark();
+    if (loopNsPerTick < 0) {
+        std::cout << "A looping chain resolved to the wrong line!" << std::endl;
+        return 1;
+    }
+    std::cout << "looping chain of depth 1000000001\tns/tick" << std::endl;
+    std::cout << "\t\t\t\t\t" << loopNsPerTick << std::endl << std::endl;
+
+    const Lollipop::IndirectionStats dispatchStats = run_dispatch_benchmark(16);
+    std::cout << "two tables, one written\thits\tmisses\tinvalidations" << std::endl;
+    std::cout << "\t\t\t" <<
+        dispatchStats.hits << "\t" <<
+        dispatchStats.misses << "\t" <<
+        dispatchStats.invalidations << std::endl << std::endl;
+    // Table B is jumped through on every third tick and should miss only once
+    if (dispatchStats.hits + 1 < NUM_TICKS / 3) {
+        std::cout << "Writing to one table invalidated another!" << std::endl;
+        return 1;
+    }
+
+    std::cout << "depth\tuncached ns/tick\tcached ns/tick\thits\tmisses\tinvalidations" << std::endl;
+
+    for (uint64_t depth : { 1, 2, 4, 8, 16, 32, 64, 128 }) {
+        const BenchmarkResult uncached = run_benchmark(depth, false);
+        const BenchmarkResult cached = run_benchmark(depth, true);
+
+        if (uncached.counter != cached.counter) {
+            std::cout << "Cached and uncached runs disagree at depth " << depth << "!" << std::endl;
+            return 1;
+        }
+
+        std::cout <<
+            depth << "\t" <<
+            uncached.nsPerTick << "\t\t\t" <<
+            cached.nsPerTick << "\t\t" <<
+            cached.stats.hits << "\t" <<
+            cached.stats.misses << "\t" <<
+            cached.stats.invalidations << std::endl;
+    }
+}
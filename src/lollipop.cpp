@@ -83,10 +83,18 @@ int main(int argc, char* argv[]) {
             Lollipop::Memory(memArr, memSize)
         );
 
-    executor.run(
+    const Lollipop::EndReason endReason = executor.run(
         [](Lollipop::Executor<uint64_t>* executor) {
-            std::cout << "Memory[0]: " << executor->memory[0] << std::endl;
+            std::cout << "Memory[0]: " << executor->memory.read(0) << std::endl;
             std::cout << "Line: " << executor->line << std::endl;
         }
     );
+
+    // Report the fault if the program crashed
+    if (endReason == Lollipop::EndReason::Error)
+        end_with_error(
+            "Fault " << Lollipop::faultStr[executor.fault] <<
+            " at line " << executor.faultLine <<
+            " (address " << executor.faultAddress << ")"
+        );
 }
\ No newline at end of file